@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+
+#include <lib/ranges.h>
+#include <map>
+#include <vector>
+
+static std::vector<int> MakeInput(size_t n) {
+  std::vector<int> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    v[i] = static_cast<int>((i * 2654435761u) % 1000);
+  }
+  return v;
+}
+
+static void BM_StaticPipeline(benchmark::State& state) {
+  auto v = MakeInput(state.range(0));
+  auto odd = v | filter([](int i) { return i % 2 == 1; });
+  auto squares = odd | transform([](int i) { return i * i; });
+  for (auto _ : state) {
+    long long sum = 0;
+    for (auto val : squares) {
+      sum += val;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StaticPipeline)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static void BM_AnyViewPipeline(benchmark::State& state) {
+  auto v = MakeInput(state.range(0));
+  auto odd = v | filter([](int i) { return i % 2 == 1; });
+  auto squares = odd | transform([](int i) { return i * i; });
+  any_view<int> view = squares;
+  for (auto _ : state) {
+    long long sum = 0;
+    for (auto val : view) {
+      sum += val;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnyViewPipeline)->Arg(1 << 10)->Arg(1 << 16)->Arg(1 << 20);
+
+static std::map<int, int> MakeMap(size_t n) {
+  std::map<int, int> m;
+  for (size_t i = 0; i < n; ++i) {
+    m[static_cast<int>(i)] = static_cast<int>((i * 2654435761u) % 1000);
+  }
+  return m;
+}
+
+constexpr int kTraversals = 8;
+
+static void BM_RepeatedTraversal(benchmark::State& state) {
+  auto m = MakeMap(state.range(0));
+  auto vals = m | values;
+  auto odd = vals | filter([](int i) { return i % 2 == 1; });
+  auto decoded = odd | transform([](int i) { return i * 7 + 1; });
+  auto reversed = decoded | reverse;
+  for (auto _ : state) {
+    long long sum = 0;
+    for (int pass = 0; pass < kTraversals; ++pass) {
+      for (auto val : reversed) {
+        sum += val;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kTraversals);
+}
+BENCHMARK(BM_RepeatedTraversal)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_RepeatedTraversalCached(benchmark::State& state) {
+  auto m = MakeMap(state.range(0));
+  auto vals = m | values;
+  auto odd = vals | filter([](int i) { return i % 2 == 1; });
+  auto decoded = odd | transform([](int i) { return i * 7 + 1; });
+  auto reversed = decoded | reverse;
+  Arena arena;
+  for (auto _ : state) {
+    long long sum = 0;
+    {
+      auto cached = reversed | cache_all(arena);
+      for (int pass = 0; pass < kTraversals; ++pass) {
+        for (auto val : cached) {
+          sum += val;
+        }
+      }
+    }
+    arena.reset();
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kTraversals);
+}
+BENCHMARK(BM_RepeatedTraversalCached)->Arg(1 << 10)->Arg(1 << 16);
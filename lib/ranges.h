@@ -0,0 +1,2068 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Iterator category that also covers raw pointers, which std::array and
+// plain arrays use as iterators.
+template <typename It>
+struct iterator_category_of {
+  using type = typename It::iterator_category;
+};
+
+template <typename It>
+struct iterator_category_of<It*> {
+  using type = std::random_access_iterator_tag;
+};
+
+template <typename It>
+using category_t = typename iterator_category_of<It>::type;
+
+// Category of an adapter that only implements the bidirectional operations:
+// the source category, at most bidirectional.
+template <typename It>
+using bidirectional_category_t =
+    std::common_type_t<category_t<It>, std::bidirectional_iterator_tag>;
+
+template <typename T>
+concept Container = requires(T container) {
+  container.begin();
+  container.end();
+  requires std::derived_from<category_t<typename T::const_iterator>,
+                             std::forward_iterator_tag>;
+};
+
+template <typename T>
+concept Pair = requires(T c) {
+  typename T::first_type;
+  typename T::second_type;
+};
+
+template <typename T>
+using element_t = std::remove_cvref_t<
+    decltype(*std::declval<typename T::const_iterator&>())>;
+
+// Iterator of a non-const T is mutable, of a const T it is read-only.
+template <typename T>
+using iterator_t = decltype(std::declval<T&>().begin());
+
+// Base of every adapter. The next stage stores a view by value: copying a
+// lazy adapter copies only its own stages, and copying an any_view clones
+// the erased pipeline. Neither copies the elements.
+struct view_base {};
+
+// Base of the views that keep their results: top_k, sorted and cache_all.
+// Copying one would evaluate the source again into a second buffer, so the
+// next stage refers to an lvalue of such a view instead.
+struct cache_view_base : view_base {};
+
+template <typename T>
+concept View = std::derived_from<std::remove_cvref_t<T>, view_base>;
+
+template <typename T>
+concept CacheView = std::derived_from<std::remove_cvref_t<T>, cache_view_base>;
+
+// How an adapter keeps its source: lvalue containers and caching views by
+// reference, other views and all rvalues by value. A pipeline therefore owns
+// its lazy stages and every cache evaluates at most once.
+template <typename T>
+using stored_t = std::conditional_t<
+    std::is_lvalue_reference_v<T> && (!View<T> || CacheView<T>), T,
+    std::remove_cvref_t<T>>;
+
+// Moves it forward by n positions without passing last.
+template <typename It>
+constexpr It advance_clamped(It it, It last, size_t n) {
+  if constexpr (std::random_access_iterator<It>) {
+    return n < static_cast<size_t>(last - it) ? it + n : last;
+  } else {
+    for (; n > 0 && it != last; --n) {
+      ++it;
+    }
+    return it;
+  }
+}
+
+template <typename R>
+class Keys : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Keys(R container)
+      : container(std::forward<R>(container)) {}
+
+  using value_type = typename T::value_type;
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+  static_assert(Pair<value_type>, "Keys requires Associative Container");
+
+  // Keys are never writable, so there is no mutable iterator.
+  class const_iterator {
+   public:
+    constexpr const_iterator(iterator_t<T> ptr) : ptr(ptr) {}
+    const_iterator(const const_iterator&) = default;
+    const_iterator& operator=(const const_iterator&) = default;
+
+    using iterator_category =
+        bidirectional_category_t<typename T::const_iterator>;
+
+    constexpr auto operator*() const { return (*ptr).first; }
+    constexpr const_iterator& operator++() {
+      ++ptr;
+      return *this;
+    }
+    constexpr const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr const_iterator& operator--() {
+      --ptr;
+      return *this;
+    }
+    constexpr const_iterator operator--(int) {
+      const_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const const_iterator& other) const = default;
+    bool operator!=(const const_iterator& other) const = default;
+
+   private:
+    iterator_t<T> ptr;
+  };
+
+  constexpr const_iterator begin() {
+    return const_iterator(container.begin());
+  }
+  constexpr const_iterator end() { return const_iterator(container.end()); }
+
+ private:
+  R container;
+};
+
+template <typename R>
+class Values : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Values(R container)
+      : container(std::forward<R>(container)) {}
+
+  using value_type = typename T::value_type;
+
+  static_assert(Pair<value_type>, "Values requires Associative Container");
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr) : ptr(ptr) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = bidirectional_category_t<It>;
+    using value_type = typename T::value_type::second_type;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const {
+      if constexpr (std::is_reference_v<decltype(*ptr)>) {
+        return ((*ptr).second);
+      } else {
+        return (*ptr).second;
+      }
+    }
+    constexpr basic_iterator& operator++() {
+      ++ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--() {
+      --ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator--(int) {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const basic_iterator& other) const = default;
+    bool operator!=(const basic_iterator& other) const = default;
+
+   private:
+    It ptr;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() { return iterator(container.begin()); }
+  constexpr iterator end() { return iterator(container.end()); }
+
+ private:
+  R container;
+};
+
+template <typename R>
+class Take : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Take(R container_, size_t n_)
+      : container(std::forward<R>(container_)), n(n_) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr) : ptr(ptr) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = bidirectional_category_t<It>;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const { return *ptr; }
+    constexpr basic_iterator& operator++() {
+      ++ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--() {
+      --ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator--(int) {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const basic_iterator& other) const = default;
+    bool operator!=(const basic_iterator& other) const = default;
+
+   private:
+    It ptr;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() { return iterator(container.begin()); }
+  constexpr iterator end() {
+    return iterator(advance_clamped(container.begin(), container.end(), n));
+  }
+
+ private:
+  R container;
+  size_t n;
+};
+
+template <typename R>
+class Drop : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Drop(R container_, size_t n_)
+      : container(std::forward<R>(container_)), n(n_) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr) : ptr(ptr) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = bidirectional_category_t<It>;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const { return *ptr; }
+    constexpr basic_iterator& operator++() {
+      ++ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--() {
+      --ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator--(int) {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const basic_iterator& other) const = default;
+    bool operator!=(const basic_iterator& other) const = default;
+
+   private:
+    It ptr;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() {
+    return iterator(advance_clamped(container.begin(), container.end(), n));
+  }
+  constexpr iterator end() { return iterator(container.end()); }
+
+ private:
+  R container;
+  size_t n;
+};
+
+template <typename R>
+class Reverse : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Reverse(R container)
+      : container(std::forward<R>(container)) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+  static_assert(std::derived_from<category_t<typename T::const_iterator>,
+                                  std::bidirectional_iterator_tag>,
+                "Reverse requires at least bidirectional iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr) : ptr(ptr) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = bidirectional_category_t<It>;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const {
+      auto it = ptr;
+      return *(--it);
+    }
+    constexpr basic_iterator& operator++() {
+      --ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--() {
+      ++ptr;
+      return *this;
+    }
+    constexpr basic_iterator operator--(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    bool operator==(const basic_iterator& other) const = default;
+    bool operator!=(const basic_iterator& other) const = default;
+
+   private:
+    It ptr;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() { return iterator(container.end()); }
+  constexpr iterator end() { return iterator(container.begin()); }
+
+ private:
+  R container;
+};
+
+template <typename R, typename F>
+class Filter : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Filter(R container, F f)
+      : container(std::forward<R>(container)), f(f) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr_, It begin_, It end_, F f_)
+        : ptr(ptr_), begin(begin_), end(end_), f(f_) {
+      while (ptr != end && !f(*ptr)) {
+        ++ptr;
+      }
+    }
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+    constexpr decltype(auto) operator*() const { return *ptr; }
+
+    using iterator_category = bidirectional_category_t<It>;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr basic_iterator& operator++() {
+      ++ptr;
+      while (ptr != end && !f(*ptr)) {
+        ++ptr;
+      }
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--() {
+      --ptr;
+      while (ptr != begin && !f(*ptr)) {
+        --ptr;
+      }
+      return *this;
+    }
+    constexpr basic_iterator operator--(int) {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+
+    // Only the position is compared, f may be a capturing lambda.
+    constexpr bool operator==(const basic_iterator& other) const {
+      return ptr == other.ptr;
+    }
+
+   private:
+    It ptr;
+    It begin;
+    It end;
+    F f;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() {
+    auto it = container.begin();
+    while (it != container.end() && !f(*it)) {
+      ++it;
+    }
+    return iterator(it, container.begin(), container.end(), f);
+  }
+  constexpr iterator end() {
+    return iterator(container.end(), container.begin(), container.end(), f);
+  }
+
+ private:
+  R container;
+  F f;
+};
+
+template <typename R, typename F>
+class Transform : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Transform(R container, F f)
+      : container(std::forward<R>(container)), f(f) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  // Transformed values are temporaries, so there is no mutable iterator.
+  class const_iterator {
+   public:
+    constexpr const_iterator(iterator_t<T> ptr, F f) : ptr(ptr), f(f) {}
+    const_iterator(const const_iterator&) = default;
+    const_iterator& operator=(const const_iterator&) = default;
+
+    using iterator_category =
+        bidirectional_category_t<typename T::const_iterator>;
+
+    constexpr auto operator*() const { return f(*ptr); }
+
+    constexpr const_iterator& operator++() {
+      ++ptr;
+      return *this;
+    }
+    constexpr const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr const_iterator& operator--() {
+      --ptr;
+      return *this;
+    }
+    constexpr const_iterator operator--(int) {
+      const_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+
+    constexpr bool operator==(const const_iterator& other) const {
+      return ptr == other.ptr;
+    }
+
+   private:
+    iterator_t<T> ptr;
+    F f;
+  };
+
+  constexpr const_iterator begin() {
+    return const_iterator(container.begin(), f);
+  }
+  constexpr const_iterator end() { return const_iterator(container.end(), f); }
+
+ private:
+  R container;
+  F f;
+};
+
+// Stops at the first element that does not satisfy f, the tail of the range
+// is never visited.
+template <typename R, typename F>
+class TakeWhile : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit TakeWhile(R container, F f)
+      : container(std::forward<R>(container)), f(f) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr_, It end_, F f_)
+        : ptr(ptr_), end(end_), f(f_), stopped(ptr == end || !f(*ptr)) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const { return *ptr; }
+    constexpr basic_iterator& operator++() {
+      ++ptr;
+      stopped = ptr == end || !f(*ptr);
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr bool operator==(const basic_iterator& other) const {
+      if (stopped || other.stopped) {
+        return stopped == other.stopped;
+      }
+      return ptr == other.ptr;
+    }
+
+   private:
+    It ptr;
+    It end;
+    F f;
+    bool stopped;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() {
+    return iterator(container.begin(), container.end(), f);
+  }
+  constexpr iterator end() {
+    return iterator(container.end(), container.end(), f);
+  }
+
+ private:
+  R container;
+  F f;
+};
+
+struct monotone_t {};
+
+// Marks a take_while predicate that holds on a prefix of the range and never
+// after it, e.g. a bound on a sorted key.
+inline constexpr monotone_t monotone;
+
+// take_while for a monotone predicate. The boundary is found with
+// partition_point when the source is random access and the source iterators
+// are returned as is, so the view keeps their category.
+template <typename R, typename F>
+class MonotoneTakeWhile : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit MonotoneTakeWhile(R container, F f)
+      : container(std::forward<R>(container)), f(f) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+  using iterator = iterator_t<T>;
+  using const_iterator = typename T::const_iterator;
+
+  constexpr iterator begin() { return container.begin(); }
+  constexpr iterator end() {
+    iterator it = container.begin();
+    iterator last = container.end();
+    if constexpr (std::random_access_iterator<iterator>) {
+      return std::partition_point(it, last, f);
+    } else {
+      while (it != last && f(*it)) {
+        ++it;
+      }
+      return it;
+    }
+  }
+
+ private:
+  R container;
+  F f;
+};
+
+// Skips the prefix that satisfies f. The first position is found once, on
+// the first call to begin(), and the source iterators are returned as is.
+template <typename R, typename F>
+class DropWhile : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit DropWhile(R container, F f)
+      : container(std::forward<R>(container)), f(f) {}
+
+  // The cached position points into the source, so a copy finds its own.
+  constexpr DropWhile(const DropWhile& other)
+      : container(other.container), f(other.f) {}
+  constexpr DropWhile(DropWhile&& other)
+      : container(std::forward<R>(other.container)), f(std::move(other.f)) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+  using iterator = iterator_t<T>;
+  using const_iterator = typename T::const_iterator;
+
+  constexpr iterator begin() {
+    if (!first) {
+      iterator it = container.begin();
+      iterator last = container.end();
+      while (it != last && f(*it)) {
+        ++it;
+      }
+      first.emplace(it);
+    }
+    return *first;
+  }
+  constexpr iterator end() { return container.end(); }
+
+ private:
+  R container;
+  F f;
+  std::optional<iterator> first;
+};
+
+// Collapses runs of equal adjacent elements into their first element.
+template <typename R>
+class Unique : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Unique(R container)
+      : container(std::forward<R>(container)) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = typename T::value_type;
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    constexpr basic_iterator(It ptr, It end) : ptr(ptr), end(end) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = element_t<T>;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr decltype(auto) operator*() const { return *ptr; }
+    constexpr basic_iterator& operator++() {
+      It prev = ptr;
+      ++ptr;
+      while (ptr != end && *ptr == *prev) {
+        ++ptr;
+      }
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    bool operator==(const basic_iterator& other) const = default;
+    bool operator!=(const basic_iterator& other) const = default;
+
+   private:
+    It ptr;
+    It end;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+
+  constexpr iterator begin() {
+    return iterator(container.begin(), container.end());
+  }
+  constexpr iterator end() {
+    return iterator(container.end(), container.end());
+  }
+
+ private:
+  R container;
+};
+
+template <typename V, size_t>
+struct repeat_type {
+  using type = V;
+};
+
+// Owned value of a window: a std::tuple of N copies of V.
+template <typename V, size_t... I>
+std::tuple<typename repeat_type<V, I>::type...> window_value(
+    std::index_sequence<I...>);
+
+template <typename It, size_t... I>
+constexpr auto dereference_window(const std::array<It, sizeof...(I)>& window,
+                                  std::index_sequence<I...>) {
+  return std::tuple<decltype(*window[I])...>(*window[I]...);
+}
+
+// Sliding windows of N consecutive elements. Dereferencing gives a std::tuple
+// of whatever the source iterators dereference to, so elements are referenced
+// rather than copied; value_type is the tuple of element values. Random
+// access when the source iterator is.
+template <typename R, size_t N>
+class Adjacent : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Adjacent(R container)
+      : container(std::forward<R>(container)) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+  static_assert(N > 0, "Adjacent requires a positive window size");
+
+  template <typename It>
+  class basic_iterator {
+   public:
+    basic_iterator() = default;
+    constexpr basic_iterator(It first, It last)
+        : window(make_window(first, last, std::make_index_sequence<N>())) {}
+    basic_iterator(const basic_iterator&) = default;
+    basic_iterator& operator=(const basic_iterator&) = default;
+
+    // operator* returns a tuple by value, so legacy algorithms only get an
+    // input iterator; the C++20 concept reports the real strength.
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept =
+        std::conditional_t<std::random_access_iterator<It>,
+                           std::random_access_iterator_tag,
+                           std::forward_iterator_tag>;
+    using value_type = decltype(window_value<element_t<T>>(
+        std::make_index_sequence<N>()));
+    using difference_type = std::ptrdiff_t;
+
+    constexpr auto operator*() const {
+      return dereference_window(window, std::make_index_sequence<N>());
+    }
+    constexpr basic_iterator& operator++() {
+      for (auto& it : window) {
+        ++it;
+      }
+      return *this;
+    }
+    constexpr basic_iterator operator++(int) {
+      basic_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator--()
+      requires std::random_access_iterator<It>
+    {
+      for (auto& it : window) {
+        --it;
+      }
+      return *this;
+    }
+    constexpr basic_iterator operator--(int)
+      requires std::random_access_iterator<It>
+    {
+      basic_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    constexpr basic_iterator& operator+=(difference_type n)
+      requires std::random_access_iterator<It>
+    {
+      for (auto& it : window) {
+        it += n;
+      }
+      return *this;
+    }
+    constexpr basic_iterator& operator-=(difference_type n)
+      requires std::random_access_iterator<It>
+    {
+      return *this += -n;
+    }
+    constexpr basic_iterator operator+(difference_type n) const
+      requires std::random_access_iterator<It>
+    {
+      basic_iterator temp = *this;
+      return temp += n;
+    }
+    friend constexpr basic_iterator operator+(difference_type n,
+                                              const basic_iterator& it)
+      requires std::random_access_iterator<It>
+    {
+      return it + n;
+    }
+    constexpr basic_iterator operator-(difference_type n) const
+      requires std::random_access_iterator<It>
+    {
+      basic_iterator temp = *this;
+      return temp -= n;
+    }
+    constexpr difference_type operator-(const basic_iterator& other) const
+      requires std::random_access_iterator<It>
+    {
+      return window[0] - other.window[0];
+    }
+    constexpr auto operator[](difference_type n) const
+      requires std::random_access_iterator<It>
+    {
+      return *(*this + n);
+    }
+    constexpr bool operator==(const basic_iterator& other) const {
+      return window[0] == other.window[0];
+    }
+    constexpr auto operator<=>(const basic_iterator& other) const
+      requires std::random_access_iterator<It>
+    {
+      return window[0] <=> other.window[0];
+    }
+
+   private:
+    template <size_t... I>
+    static constexpr std::array<It, N> make_window(It first, It last,
+                                                   std::index_sequence<I...>) {
+      return {advance_clamped(first, last, I)...};
+    }
+
+    std::array<It, N> window;
+  };
+
+  using iterator = basic_iterator<iterator_t<T>>;
+  using const_iterator = basic_iterator<typename T::const_iterator>;
+  using value_type = typename const_iterator::value_type;
+
+  constexpr iterator begin() {
+    return iterator(container.begin(), container.end());
+  }
+  constexpr iterator end() {
+    iterator_t<T> first = container.begin();
+    iterator_t<T> last = container.end();
+    if constexpr (std::random_access_iterator<iterator_t<T>>) {
+      auto size = static_cast<size_t>(last - first);
+      first += size < N ? 0 : size - N + 1;
+    } else {
+      iterator_t<T> lead = advance_clamped(first, last, N - 1);
+      while (lead != last) {
+        ++lead;
+        ++first;
+      }
+    }
+    return iterator(first, last);
+  }
+
+ private:
+  R container;
+};
+
+// Half-open range of consecutive values [first, last) that owns no storage.
+template <typename I>
+class Iota : public view_base {
+ public:
+  constexpr explicit Iota(I first, I last) : first(first), last(last) {}
+
+  using value_type = I;
+
+  class const_iterator {
+   public:
+    constexpr const_iterator(I value) : value(value) {}
+    const_iterator(const const_iterator&) = default;
+    const_iterator& operator=(const const_iterator&) = default;
+
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = I;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr I operator*() const { return value; }
+    constexpr const_iterator& operator++() {
+      ++value;
+      return *this;
+    }
+    constexpr const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr const_iterator& operator--() {
+      --value;
+      return *this;
+    }
+    constexpr const_iterator operator--(int) {
+      const_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const const_iterator& other) const = default;
+    bool operator!=(const const_iterator& other) const = default;
+
+   private:
+    I value;
+  };
+
+  constexpr const_iterator begin() const { return const_iterator(first); }
+  constexpr const_iterator end() const {
+    return const_iterator(first < last ? last : first);
+  }
+
+ private:
+  I first;
+  I last;
+};
+
+// Yields the k first elements of the range in cmp order. The input is
+// streamed once through a bounded heap, so memory stays O(k) and the cost is
+// O(n log k). Evaluated on the first call to begin() or end().
+template <typename R, typename Cmp>
+class TopK : public cache_view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit TopK(R container, size_t k, Cmp cmp)
+      : container(std::forward<R>(container)), k(k), cmp(cmp) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = element_t<T>;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  constexpr const_iterator begin() {
+    evaluate();
+    return heap.cbegin();
+  }
+  constexpr const_iterator end() {
+    evaluate();
+    return heap.cend();
+  }
+
+ private:
+  constexpr void evaluate() {
+    if (evaluated) {
+      return;
+    }
+    evaluated = true;
+    if (k == 0) {
+      return;
+    }
+    auto last = container.end();
+    for (auto it = container.begin(); it != last; ++it) {
+      if (heap.size() < k) {
+        heap.push_back(*it);
+        std::push_heap(heap.begin(), heap.end(), cmp);
+      } else if (cmp(*it, heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), cmp);
+        heap.back() = *it;
+        std::push_heap(heap.begin(), heap.end(), cmp);
+      }
+    }
+    std::sort_heap(heap.begin(), heap.end(), cmp);
+  }
+
+  R container;
+  size_t k;
+  Cmp cmp;
+  std::vector<value_type> heap;
+  bool evaluated = false;
+};
+
+// Sorted view that orders elements on demand. The range is copied once on
+// the first call to begin() or end(); dereferencing past the sorted prefix
+// runs incremental introselect, which partitions only the leftmost unsorted
+// segment and keeps the pivot boundaries for later reads. sorted() | take(k)
+// costs expected O(n + k log k) and O(n log n) at worst. The copy holds all
+// n elements; top_k() keeps only k of them.
+template <typename R, typename Cmp>
+class Sorted : public cache_view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  constexpr explicit Sorted(R container, Cmp cmp)
+      : container(std::forward<R>(container)), cmp(cmp) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = element_t<T>;
+
+  class const_iterator {
+   public:
+    constexpr const_iterator(Sorted* owner, size_t index)
+        : owner(owner), index(index) {}
+    const_iterator(const const_iterator&) = default;
+    const_iterator& operator=(const const_iterator&) = default;
+
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Sorted::value_type;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr const value_type& operator*() const { return owner->at(index); }
+    constexpr const_iterator& operator++() {
+      ++index;
+      return *this;
+    }
+    constexpr const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    constexpr const_iterator& operator--() {
+      --index;
+      return *this;
+    }
+    constexpr const_iterator operator--(int) {
+      const_iterator temp = *this;
+      --(*this);
+      return temp;
+    }
+    bool operator==(const const_iterator& other) const = default;
+    bool operator!=(const const_iterator& other) const = default;
+
+   private:
+    Sorted* owner;
+    size_t index;
+  };
+
+  constexpr const_iterator begin() {
+    evaluate();
+    return const_iterator(this, 0);
+  }
+  constexpr const_iterator end() {
+    evaluate();
+    return const_iterator(this, buffer.size());
+  }
+
+ private:
+  static constexpr size_t kSmallSegment = 16;
+
+  struct Segment {
+    size_t end;
+    // Partitions left before the segment is sorted whole, as in introselect.
+    size_t depth;
+  };
+
+  constexpr void evaluate() {
+    if (evaluated) {
+      return;
+    }
+    evaluated = true;
+    auto last = container.end();
+    for (auto it = container.begin(); it != last; ++it) {
+      buffer.push_back(*it);
+    }
+    size_t depth = 0;
+    for (size_t size = buffer.size(); size > 1; size /= 2) {
+      depth += 2;
+    }
+    bounds.push_back(Segment{buffer.size(), depth});
+  }
+
+  // buffer[0, sorted_end) is final. The unsorted rest is split into segments
+  // whose right ends are kept on the bounds stack, nearest on top; every
+  // element of a segment precedes every element of the segments after it.
+  constexpr const value_type& at(size_t index) {
+    while (sorted_end <= index) {
+      Segment& segment = bounds.back();
+      auto first = buffer.begin() + sorted_end;
+      auto last = buffer.begin() + segment.end;
+      // Small segments, and segments that saw too many bad pivots, are
+      // sorted whole; std::sort is O(s log s) at worst.
+      if (segment.end - sorted_end <= kSmallSegment || segment.depth == 0) {
+        std::sort(first, last, cmp);
+        sorted_end = segment.end;
+        bounds.pop_back();
+        continue;
+      }
+      size_t depth = --segment.depth;
+      value_type pivot = median(*first, first[(last - first) / 2], last[-1]);
+      auto mid = std::partition(
+          first, last, [&](const value_type& x) { return cmp(x, pivot); });
+      if (mid != first) {
+        bounds.push_back(Segment{static_cast<size_t>(mid - buffer.begin()),
+                                 depth});
+        continue;
+      }
+      // Nothing precedes the pivot, so the block of its equals is final.
+      mid = std::partition(
+          first, last, [&](const value_type& x) { return !cmp(pivot, x); });
+      sorted_end = mid - buffer.begin();
+      if (mid == last) {
+        bounds.pop_back();
+      }
+    }
+    return buffer[index];
+  }
+
+  constexpr const value_type& median(const value_type& a, const value_type& b,
+                                     const value_type& c) const {
+    if (cmp(a, b)) {
+      return cmp(b, c) ? b : (cmp(a, c) ? c : a);
+    }
+    return cmp(a, c) ? a : (cmp(b, c) ? c : b);
+  }
+
+  R container;
+  Cmp cmp;
+  std::vector<value_type> buffer;
+  std::vector<Segment> bounds;
+  size_t sorted_end = 0;
+  bool evaluated = false;
+};
+
+// Open-addressing hash map with linear probing. Entries are stored densely in
+// insertion order, the probe table only holds entry indices, so iteration is
+// a contiguous scan and keys()/values() apply directly. clear() keeps both
+// buffers allocated, which lets one table be reused across aggregations.
+template <typename K, typename V, typename Hash = std::hash<K>>
+class FlatMap {
+ public:
+  using value_type = std::pair<K, V>;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  V& find_or_insert(const K& key, const V& init) {
+    if ((entries.size() + 1) * 4 > slots.size() * 3) {
+      grow();
+    }
+    size_t slot = probe(key);
+    if (slots[slot] == 0) {
+      entries.emplace_back(key, init);
+      slots[slot] = entries.size();
+    }
+    return entries[slots[slot] - 1].second;
+  }
+
+  const V* find(const K& key) const {
+    if (slots.empty()) {
+      return nullptr;
+    }
+    size_t slot = probe(key);
+    return slots[slot] == 0 ? nullptr : &entries[slots[slot] - 1].second;
+  }
+
+  // Folds the partial table of another thread into this one.
+  template <typename Combine>
+  void merge(const FlatMap& other, Combine combine) {
+    for (const auto& [key, value] : other.entries) {
+      size_t before = entries.size();
+      V& acc = find_or_insert(key, value);
+      if (entries.size() == before) {
+        acc = combine(acc, value);
+      }
+    }
+  }
+
+  void clear() {
+    entries.clear();
+    std::fill(slots.begin(), slots.end(), 0);
+  }
+
+  size_t size() const { return entries.size(); }
+  bool empty() const { return entries.empty(); }
+
+  const_iterator begin() const { return entries.cbegin(); }
+  const_iterator end() const { return entries.cend(); }
+
+ private:
+  size_t probe(const K& key) const {
+    uint64_t h = static_cast<uint64_t>(hash(key)) * 0x9E3779B97F4A7C15ull;
+    size_t mask = slots.size() - 1;
+    size_t slot = static_cast<size_t>(h >> shift) & mask;
+    while (slots[slot] != 0 && !(entries[slots[slot] - 1].first == key)) {
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void grow() {
+    size_t capacity = slots.empty() ? 16 : slots.size() * 2;
+    shift = 64;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      --shift;
+    }
+    slots.assign(capacity, 0);
+    entries.reserve(capacity * 3 / 4);
+    for (size_t i = 0; i < entries.size(); ++i) {
+      slots[probe(entries[i].first)] = i + 1;
+    }
+  }
+
+  std::vector<value_type> entries;
+  std::vector<size_t> slots;
+  unsigned shift = 64;
+  Hash hash;
+};
+
+// Intermediate stage of group_by(key_fn) | aggregate(init, op): keeps the
+// range and the key function, the aggregation itself is eager.
+template <typename R, typename KeyFn>
+class GroupBy : public view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  explicit GroupBy(R container, KeyFn key_fn)
+      : container(std::forward<R>(container)), key_fn(key_fn) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using key_type =
+      std::remove_cvref_t<std::invoke_result_t<KeyFn&, const element_t<T>&>>;
+
+  template <typename V, typename Op>
+  FlatMap<key_type, V> aggregate(const V& init, Op op) {
+    FlatMap<key_type, V> table;
+    aggregate_into(table, init, op);
+    return table;
+  }
+
+  template <typename V, typename Op>
+  void aggregate_into(FlatMap<key_type, V>& table, const V& init, Op op) {
+    auto last = container.end();
+    for (auto it = container.begin(); it != last; ++it) {
+      const auto& value = *it;
+      V& acc = table.find_or_insert(key_fn(value), init);
+      acc = op(acc, value);
+    }
+  }
+
+ private:
+  R container;
+  KeyFn key_fn;
+};
+
+// Owns an object derived from Base. Objects that fit into Size bytes are kept
+// in place, larger ones go to the heap. Base has to provide
+// clone_into(void*) and move_into(void*) that construct a copy in the given
+// storage when the derived type fits and on the heap otherwise.
+template <typename Base, size_t Size>
+class SmallBox {
+ public:
+  SmallBox() = default;
+  SmallBox(const SmallBox& other) { copy_from(other); }
+  SmallBox(SmallBox&& other) noexcept { move_from(other); }
+  SmallBox& operator=(const SmallBox& other) {
+    if (this != &other) {
+      reset();
+      copy_from(other);
+    }
+    return *this;
+  }
+  SmallBox& operator=(SmallBox&& other) noexcept {
+    if (this != &other) {
+      reset();
+      move_from(other);
+    }
+    return *this;
+  }
+  ~SmallBox() { reset(); }
+
+  template <typename D>
+  static constexpr bool fits() {
+    return sizeof(D) <= Size && alignof(D) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible_v<D>;
+  }
+
+  template <typename D, typename... Args>
+  void emplace(Args&&... args) {
+    reset();
+    if constexpr (fits<D>()) {
+      ptr = new (storage) D(std::forward<Args>(args)...);
+    } else {
+      ptr = new D(std::forward<Args>(args)...);
+    }
+  }
+
+  void reset() {
+    if (ptr == nullptr) {
+      return;
+    }
+    if (is_local()) {
+      ptr->~Base();
+    } else {
+      delete ptr;
+    }
+    ptr = nullptr;
+  }
+
+  Base* operator->() const { return ptr; }
+  Base& operator*() const { return *ptr; }
+  explicit operator bool() const { return ptr != nullptr; }
+
+ private:
+  bool is_local() const { return dynamic_cast<void*>(ptr) == storage; }
+
+  void copy_from(const SmallBox& other) {
+    if (other.ptr != nullptr) {
+      ptr = other.ptr->clone_into(storage);
+    }
+  }
+  void move_from(SmallBox& other) {
+    if (other.ptr == nullptr) {
+      return;
+    }
+    if (other.is_local()) {
+      ptr = other.ptr->move_into(storage);
+      other.reset();
+    } else {
+      ptr = other.ptr;
+      other.ptr = nullptr;
+    }
+  }
+
+  alignas(std::max_align_t) unsigned char storage[Size];
+  Base* ptr = nullptr;
+};
+
+// Type-erased forward view over any range whose elements convert to V, so
+// pipelines of different types can be stored in one variable. An lvalue range
+// is referenced like in the other adapters, an rvalue one is moved in. The
+// iterator pulls kBatch elements per virtual call into its own buffer, so the
+// erasure costs one indirect call per batch rather than per element.
+template <typename V>
+class AnyView : public view_base {
+  static constexpr size_t kBatch = 32;
+  static constexpr size_t kViewBuffer = 64;
+  static constexpr size_t kCursorBuffer = 128;
+
+  struct Cursor {
+    virtual ~Cursor() = default;
+    virtual size_t fill(V* out, size_t n) = 0;
+    virtual Cursor* clone_into(void* storage) const = 0;
+    virtual Cursor* move_into(void* storage) = 0;
+  };
+
+  using CursorBox = SmallBox<Cursor, kCursorBuffer>;
+
+  struct Source {
+    virtual ~Source() = default;
+    virtual void open(CursorBox& cursor) = 0;
+    virtual Source* clone_into(void* storage) const = 0;
+    virtual Source* move_into(void* storage) = 0;
+  };
+
+  using SourceBox = SmallBox<Source, kViewBuffer>;
+
+  template <typename It>
+  struct CursorModel final : Cursor {
+    CursorModel(It it, It last) : it(it), last(last) {}
+
+    size_t fill(V* out, size_t n) override {
+      size_t count = 0;
+      for (; count < n && it != last; ++it, ++count) {
+        out[count] = *it;
+      }
+      return count;
+    }
+    Cursor* clone_into(void* storage) const override {
+      if constexpr (CursorBox::template fits<CursorModel>()) {
+        return new (storage) CursorModel(*this);
+      } else {
+        return new CursorModel(*this);
+      }
+    }
+    Cursor* move_into(void* storage) override {
+      return new (storage) CursorModel(std::move(*this));
+    }
+
+    It it;
+    It last;
+  };
+
+  template <typename R>
+  struct SourceModel final : Source {
+    template <typename U>
+    explicit SourceModel(U&& range) : range(std::forward<U>(range)) {}
+
+    void open(CursorBox& cursor) override {
+      using It = iterator_t<std::remove_reference_t<R>>;
+      cursor.template emplace<CursorModel<It>>(range.begin(), range.end());
+    }
+    Source* clone_into(void* storage) const override {
+      if constexpr (SourceBox::template fits<SourceModel>()) {
+        return new (storage) SourceModel(*this);
+      } else {
+        return new SourceModel(*this);
+      }
+    }
+    Source* move_into(void* storage) override {
+      return new (storage) SourceModel(std::move(*this));
+    }
+
+    R range;
+  };
+
+ public:
+  using value_type = V;
+
+  AnyView() = default;
+
+  template <typename R>
+    requires(!std::same_as<std::remove_cvref_t<R>, AnyView>)
+  AnyView(R&& range) {
+    static_assert(Container<std::remove_reference_t<R>>,
+                  "Container requires begin() and end() and at least forward "
+                  "iterator");
+    source.template emplace<SourceModel<stored_t<R>>>(std::forward<R>(range));
+  }
+
+  class const_iterator {
+   public:
+    const_iterator() = default;
+    explicit const_iterator(Source& source) {
+      source.open(cursor);
+      refill();
+    }
+    const_iterator(const const_iterator&) = default;
+    const_iterator& operator=(const const_iterator&) = default;
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = V;
+    using difference_type = std::ptrdiff_t;
+
+    const V& operator*() const { return batch[pos]; }
+    const_iterator& operator++() {
+      ++pos;
+      ++consumed;
+      if (pos == count) {
+        refill();
+      }
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator temp = *this;
+      ++(*this);
+      return temp;
+    }
+    bool operator==(const const_iterator& other) const {
+      if (at_end() || other.at_end()) {
+        return at_end() == other.at_end();
+      }
+      return consumed == other.consumed;
+    }
+
+   private:
+    bool at_end() const { return pos == count; }
+    void refill() {
+      pos = 0;
+      count = cursor ? cursor->fill(batch.data(), kBatch) : 0;
+    }
+
+    CursorBox cursor;
+    std::array<V, kBatch> batch{};
+    size_t pos = 0;
+    size_t count = 0;
+    size_t consumed = 0;
+  };
+
+  const_iterator begin() {
+    return source ? const_iterator(*source) : const_iterator();
+  }
+  const_iterator end() { return const_iterator(); }
+
+ private:
+  SourceBox source;
+};
+
+template <typename V>
+using any_view = AnyView<V>;
+
+// Bump allocator for cache_all() and other std::pmr users. Blocks are kept
+// between resets, so reset() is O(1) and a warmed-up arena stops allocating.
+// Everything allocated from the arena must be destroyed before reset().
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(size_t block_size = 64 * 1024) : block_size(block_size) {}
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void reset() {
+    current = 0;
+    offset = 0;
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    while (true) {
+      if (current == blocks.size()) {
+        size_t size = std::max(block_size, bytes + alignment);
+        blocks.push_back(Block{std::make_unique<std::byte[]>(size), size});
+      }
+      Block& block = blocks[current];
+      auto base = reinterpret_cast<uintptr_t>(block.data.get());
+      uintptr_t start = (base + offset + alignment - 1) & ~(alignment - 1);
+      if (start + bytes <= base + block.size) {
+        offset = start + bytes - base;
+        return reinterpret_cast<void*>(start);
+      }
+      ++current;
+      offset = 0;
+    }
+  }
+
+  void do_deallocate(void*, size_t, size_t) override {}
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+
+  size_t block_size;
+  std::vector<Block> blocks;
+  size_t current = 0;
+  size_t offset = 0;
+};
+
+// Evaluates the range once, on the first access, into contiguous storage
+// taken from the given memory resource. Later traversals walk a plain array.
+// A source that is not random access is sized by growing, which costs at most
+// twice the final buffer in a bump arena.
+template <typename R>
+class CacheAll : public cache_view_base {
+  using T = std::remove_reference_t<R>;
+
+ public:
+  explicit CacheAll(R container, std::pmr::memory_resource* resource)
+      : container(std::forward<R>(container)), buffer(resource) {}
+
+  static_assert(
+      Container<T>,
+      "Container requires begin() and end() and at least forward iterator");
+
+  using value_type = element_t<T>;
+  using const_iterator = const value_type*;
+
+  const_iterator begin() {
+    evaluate();
+    return buffer.data();
+  }
+  const_iterator end() {
+    evaluate();
+    return buffer.data() + buffer.size();
+  }
+  size_t size() {
+    evaluate();
+    return buffer.size();
+  }
+  const value_type& operator[](size_t index) {
+    evaluate();
+    return buffer[index];
+  }
+
+ private:
+  void evaluate() {
+    if (evaluated) {
+      return;
+    }
+    evaluated = true;
+    auto it = container.begin();
+    auto last = container.end();
+    if constexpr (std::random_access_iterator<decltype(it)>) {
+      buffer.reserve(last - it);
+      for (; it != last; ++it) {
+        buffer.push_back(*it);
+      }
+    } else {
+      // The size is unknown, so the buffer grows inside the resource. The
+      // capacity doubles, so in a bump arena the outgrown buffers together
+      // take less space than the final one.
+      for (; it != last; ++it) {
+        if (buffer.size() == buffer.capacity()) {
+          buffer.reserve(std::max<size_t>(2 * buffer.capacity(), 16));
+        }
+        buffer.push_back(*it);
+      }
+    }
+  }
+
+  R container;
+  std::pmr::vector<value_type> buffer;
+  bool evaluated = false;
+};
+
+struct keys_buff {};
+
+struct values_buff {};
+
+struct take_buff {
+  constexpr take_buff(size_t n) : n(n) {}
+  size_t n;
+};
+
+struct drop_buff {
+  constexpr drop_buff(size_t n) : n(n) {}
+  size_t n;
+};
+
+struct reverse_buff {};
+
+template <typename F>
+struct filter_buff {
+  constexpr filter_buff(F f) : f(f) {}
+  F f;
+};
+
+template <typename F>
+struct transform_buff {
+  constexpr transform_buff(F f) : f(f) {}
+  F f;
+};
+
+template <typename F>
+struct take_while_buff {
+  constexpr take_while_buff(F f) : f(f) {}
+  F f;
+};
+
+template <typename F>
+struct monotone_take_while_buff {
+  constexpr monotone_take_while_buff(F f) : f(f) {}
+  F f;
+};
+
+template <typename F>
+struct drop_while_buff {
+  constexpr drop_while_buff(F f) : f(f) {}
+  F f;
+};
+
+struct unique_buff {};
+
+template <size_t N>
+struct adjacent_buff {};
+
+template <typename Cmp>
+struct top_k_buff {
+  constexpr top_k_buff(size_t k, Cmp cmp) : k(k), cmp(cmp) {}
+  size_t k;
+  Cmp cmp;
+};
+
+template <typename Cmp>
+struct sorted_buff {
+  constexpr sorted_buff(Cmp cmp) : cmp(cmp) {}
+  Cmp cmp;
+};
+
+template <typename F>
+struct group_by_buff {
+  group_by_buff(F f) : f(f) {}
+  F f;
+};
+
+template <typename V, typename Op>
+struct aggregate_buff {
+  aggregate_buff(V init, Op op) : init(init), op(op) {}
+  V init;
+  Op op;
+};
+
+template <typename F>
+struct count_by_buff {
+  count_by_buff(F f) : f(f) {}
+  F f;
+};
+
+struct cache_all_buff {
+  cache_all_buff(std::pmr::memory_resource* resource) : resource(resource) {}
+  std::pmr::memory_resource* resource;
+};
+
+template <typename T>
+constexpr Keys<stored_t<T&>> keys(T& container) {
+  return Keys<stored_t<T&>>(container);
+}
+
+template <typename T>
+constexpr Values<stored_t<T&>> values(T& container) {
+  return Values<stored_t<T&>>(container);
+}
+
+template <typename T>
+constexpr Take<stored_t<T&>> take(T& container, size_t n) {
+  return Take<stored_t<T&>>(container, n);
+}
+
+template <typename T>
+constexpr Drop<stored_t<T&>> drop(T& container, size_t n) {
+  return Drop<stored_t<T&>>(container, n);
+}
+
+template <typename T>
+constexpr Reverse<stored_t<T&>> reverse(T& container) {
+  return Reverse<stored_t<T&>>(container);
+}
+
+template <typename T, typename F>
+constexpr Filter<stored_t<T&>, F> filter(T& container, F f) {
+  return Filter<stored_t<T&>, F>(container, f);
+}
+
+template <typename T, typename F>
+constexpr Transform<stored_t<T&>, F> transform(T& container, F f) {
+  return Transform<stored_t<T&>, F>(container, f);
+}
+
+template <typename T, typename F>
+constexpr TakeWhile<stored_t<T&>, F> take_while(T& container, F f) {
+  return TakeWhile<stored_t<T&>, F>(container, f);
+}
+
+template <typename T, typename F>
+constexpr MonotoneTakeWhile<stored_t<T&>, F> take_while(T& container, F f,
+                                                       monotone_t) {
+  return MonotoneTakeWhile<stored_t<T&>, F>(container, f);
+}
+
+template <typename T, typename F>
+constexpr DropWhile<stored_t<T&>, F> drop_while(T& container, F f) {
+  return DropWhile<stored_t<T&>, F>(container, f);
+}
+
+template <typename T>
+constexpr Unique<stored_t<T&>> unique(T& container) {
+  return Unique<stored_t<T&>>(container);
+}
+
+template <size_t N, typename T>
+constexpr Adjacent<stored_t<T&>, N> adjacent(T& container) {
+  return Adjacent<stored_t<T&>, N>(container);
+}
+
+template <typename T>
+constexpr Adjacent<stored_t<T&>, 2> pairwise(T& container) {
+  return Adjacent<stored_t<T&>, 2>(container);
+}
+
+template <typename T, typename Cmp = std::less<>>
+constexpr TopK<stored_t<T&>, Cmp> top_k(T& container, size_t k,
+                                        Cmp cmp = Cmp()) {
+  return TopK<stored_t<T&>, Cmp>(container, k, cmp);
+}
+
+template <typename T, typename Cmp = std::less<>>
+  requires Container<T>
+constexpr Sorted<stored_t<T&>, Cmp> sorted(T& container, Cmp cmp = Cmp()) {
+  return Sorted<stored_t<T&>, Cmp>(container, cmp);
+}
+
+template <typename T, typename F>
+GroupBy<stored_t<T&>, F> group_by(T& container, F f) {
+  return GroupBy<stored_t<T&>, F>(container, f);
+}
+
+template <typename T, typename F>
+auto count_by(T& container, F f) {
+  return GroupBy<stored_t<T&>, F>(container, f).aggregate(
+      size_t(0), [](size_t acc, const auto&) { return acc + 1; });
+}
+
+template <typename T>
+CacheAll<stored_t<T&>> cache_all(T& container,
+                                  std::pmr::memory_resource& resource) {
+  return CacheAll<stored_t<T&>>(container, &resource);
+}
+
+constexpr keys_buff keys() { return keys_buff(); }
+
+constexpr values_buff values() { return values_buff(); }
+
+constexpr take_buff take(size_t n) { return take_buff(n); }
+
+constexpr drop_buff drop(size_t n) { return drop_buff(n); }
+
+constexpr reverse_buff reverse() { return reverse_buff(); }
+
+template <typename F>
+constexpr filter_buff<F> filter(F f) {
+  return filter_buff<F>(f);
+}
+
+template <typename F>
+constexpr transform_buff<F> transform(F f) {
+  return transform_buff<F>(f);
+}
+
+template <typename F>
+constexpr take_while_buff<F> take_while(F f) {
+  return take_while_buff<F>(f);
+}
+
+template <typename F>
+constexpr monotone_take_while_buff<F> take_while(F f, monotone_t) {
+  return monotone_take_while_buff<F>(f);
+}
+
+template <typename F>
+constexpr drop_while_buff<F> drop_while(F f) {
+  return drop_while_buff<F>(f);
+}
+
+constexpr unique_buff unique() { return unique_buff(); }
+
+template <size_t N>
+constexpr adjacent_buff<N> adjacent() {
+  return adjacent_buff<N>();
+}
+
+constexpr adjacent_buff<2> pairwise() { return adjacent_buff<2>(); }
+
+template <typename Cmp = std::less<>>
+constexpr top_k_buff<Cmp> top_k(size_t k, Cmp cmp = Cmp()) {
+  return top_k_buff<Cmp>(k, cmp);
+}
+
+template <typename Cmp = std::less<>>
+  requires(!Container<Cmp>)
+constexpr sorted_buff<Cmp> sorted(Cmp cmp = Cmp()) {
+  return sorted_buff<Cmp>(cmp);
+}
+
+template <typename I>
+constexpr Iota<I> iota(I first, I last) {
+  return Iota<I>(first, last);
+}
+
+template <typename F>
+group_by_buff<F> group_by(F f) {
+  return group_by_buff<F>(f);
+}
+
+template <typename V, typename Op>
+aggregate_buff<V, Op> aggregate(V init, Op op) {
+  return aggregate_buff<V, Op>(init, op);
+}
+
+template <typename F>
+count_by_buff<F> count_by(F f) {
+  return count_by_buff<F>(f);
+}
+
+inline cache_all_buff cache_all(std::pmr::memory_resource& resource) {
+  return cache_all_buff(&resource);
+}
+
+inline cache_all_buff cache_all() {
+  return cache_all_buff(std::pmr::get_default_resource());
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, keys_buff()) {
+  return Keys<stored_t<T>>(std::forward<T>(r));
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, values_buff()) {
+  return Values<stored_t<T>>(std::forward<T>(r));
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, take_buff b) {
+  return Take<stored_t<T>>(std::forward<T>(r), b.n);
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, drop_buff b) {
+  return Drop<stored_t<T>>(std::forward<T>(r), b.n);
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, reverse_buff()) {
+  return Reverse<stored_t<T>>(std::forward<T>(r));
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T&& r, filter_buff<F> b) {
+  return Filter<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T&& r, transform_buff<F> b) {
+  return Transform<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T&& r, take_while_buff<F> b) {
+  return TakeWhile<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T&& r, monotone_take_while_buff<F> b) {
+  return MonotoneTakeWhile<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T, typename F>
+constexpr auto operator|(T&& r, drop_while_buff<F> b) {
+  return DropWhile<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, unique_buff()) {
+  return Unique<stored_t<T>>(std::forward<T>(r));
+}
+
+template <typename T, size_t N>
+constexpr auto operator|(T&& r, adjacent_buff<N>) {
+  return Adjacent<stored_t<T>, N>(std::forward<T>(r));
+}
+
+template <typename T>
+constexpr auto operator|(T&& r, adjacent_buff<2>()) {
+  return Adjacent<stored_t<T>, 2>(std::forward<T>(r));
+}
+
+template <typename T, typename Cmp>
+constexpr auto operator|(T&& r, top_k_buff<Cmp> b) {
+  return TopK<stored_t<T>, Cmp>(std::forward<T>(r), b.k, b.cmp);
+}
+
+template <typename T, typename Cmp>
+constexpr auto operator|(T&& r, sorted_buff<Cmp> b) {
+  return Sorted<stored_t<T>, Cmp>(std::forward<T>(r), b.cmp);
+}
+
+template <typename T, typename F>
+auto operator|(T&& r, group_by_buff<F> b) {
+  return GroupBy<stored_t<T>, F>(std::forward<T>(r), b.f);
+}
+
+template <typename T, typename F, typename V, typename Op>
+auto operator|(GroupBy<T, F> g, aggregate_buff<V, Op> b) {
+  return g.aggregate(b.init, b.op);
+}
+
+template <typename T, typename F>
+auto operator|(T&& r, count_by_buff<F> b) {
+  return count_by(r, b.f);
+}
+
+template <typename T>
+auto operator|(T&& r, cache_all_buff b) {
+  return CacheAll<stored_t<T>>(std::forward<T>(r), b.resource);
+}
+
+// Copies the range into a std::array of exactly N elements. A range of any
+// other length throws std::length_error, so in a constant expression the
+// mismatch is a compile error.
+template <size_t N, typename T>
+constexpr auto to_array(T&& range) {
+  std::array<element_t<std::remove_reference_t<T>>, N> result{};
+  auto it = range.begin();
+  auto last = range.end();
+  size_t i = 0;
+  for (; i < N && it != last; ++it, ++i) {
+    result[i] = *it;
+  }
+  if (i != N || it != last) {
+    throw std::length_error("to_array: range length differs from N");
+  }
+  return result;
+}
@@ -2,11 +2,14 @@
 
 #include <deque>
 #include <forward_list>
+#include <functional>
 #include <iostream>
-#include <lib/ranges.cpp>
+#include <lib/ranges.h>
+#include <list>
 #include <map>
 #include <ranges>
 #include <set>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -260,3 +263,604 @@ TEST(RangesTestSuit, ListTest2) {
     ++i;
   }
 }
+
+TEST(RangesTestSuit, TopKTest) {
+  vector<int> v = {7, 1, 8, 9, 10, 11, 2, 3, 4, 5};
+  vector<int> ans = {11, 10, 9};
+  int i = 0;
+  for (auto val : v | top_k(3, greater<>())) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 3);
+}
+
+TEST(RangesTestSuit, SortedTest) {
+  vector<int> v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back((i * 37) % 100);
+  }
+  int i = 0;
+  for (auto val : sorted(v, less<>())) {
+    ASSERT_EQ(val, i);
+    ++i;
+  }
+  ASSERT_EQ(i, 100);
+}
+
+TEST(RangesTestSuit, SortedPipelineTest) {
+  list<int> l = {5, 4, 1, 6, 7, 8, 100, 3, 12, 15, 2};
+  vector<int> ans = {2, 4, 6};
+  vector<int> top = {100, 15};
+  int i = 0;
+  for (auto val : l | filter([](int i) { return i % 2 == 0; }) | sorted() |
+                      take(3)) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 3);
+  i = 0;
+  for (auto val : l | top_k(5) | reverse | take(2)) {
+    ASSERT_EQ(val, 5 - i);
+    ++i;
+  }
+  ASSERT_EQ(i, 2);
+  i = 0;
+  for (auto val : l | sorted(greater<>()) | take(2)) {
+    ASSERT_EQ(val, top[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 2);
+}
+
+TEST(RangesTestSuit, SortedPrefixTest) {
+  vector<int> v;
+  for (int i = 0; i < 5000; ++i) {
+    v.push_back((i * 7919) % 1237);
+  }
+  vector<int> ans = v;
+  std::sort(ans.begin(), ans.end());
+  for (size_t k : {1, 16, 17, 100, 1236, 5000}) {
+    size_t i = 0;
+    for (auto val : v | sorted() | take(k)) {
+      ASSERT_EQ(val, ans[i]);
+      ++i;
+    }
+    ASSERT_EQ(i, k);
+  }
+  auto all = sorted(v);
+  ASSERT_TRUE(std::equal(all.begin(), all.end(), ans.begin(), ans.end()));
+  vector<int> same(100, 7);
+  int count = 0;
+  for (auto val : same | sorted() | take(50)) {
+    ASSERT_EQ(val, 7);
+    ++count;
+  }
+  ASSERT_EQ(count, 50);
+}
+
+TEST(RangesTestSuit, SortedAdversarialTest) {
+  // Ascending input with the three largest values where median-of-three
+  // looks for its pivot.
+  const int n = 10000;
+  vector<int> v;
+  for (int i = 0; i < n; ++i) {
+    v.push_back(i - 1);
+  }
+  v[0] = n - 3;
+  v[n / 2] = n - 2;
+  v[n - 1] = n - 1;
+  long comparisons = 0;
+  auto cmp = [&comparisons](int a, int b) {
+    ++comparisons;
+    return a < b;
+  };
+  auto smallest = v | sorted(cmp) | take(1);
+  ASSERT_EQ(*smallest.begin(), 0);
+  // 8 n log2 n; quickselect without a depth limit needs about 130 n log2 n
+  // on this input.
+  ASSERT_LT(comparisons, 8L * n * 14);
+}
+
+TEST(RangesTestSuit, GroupByTest) {
+  vector<pair<string, int>> v = {
+      {"a", 1}, {"b", 2}, {"a", 3}, {"c", 4}, {"b", 5}, {"a", 6}};
+  auto key = [](const pair<string, int>& p) { return p.first; };
+  auto table = v | group_by(key) |
+               aggregate(0, [](int acc, const pair<string, int>& p) {
+                 return acc + p.second;
+               });
+  ASSERT_EQ(table.size(), 3u);
+  ASSERT_EQ(*table.find("a"), 10);
+  ASSERT_EQ(*table.find("b"), 7);
+  ASSERT_EQ(*table.find("c"), 4);
+  ASSERT_EQ(table.find("d"), nullptr);
+  vector<string> ans_keys = {"a", "b", "c"};
+  vector<int> ans_values = {10, 7, 4};
+  int i = 0;
+  for (auto key : table | keys) {
+    ASSERT_EQ(key, ans_keys[i]);
+    ++i;
+  }
+  i = 0;
+  for (auto value : table | values) {
+    ASSERT_EQ(value, ans_values[i]);
+    ++i;
+  }
+}
+
+TEST(RangesTestSuit, CountByTest) {
+  vector<int> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i);
+  }
+  auto table = v | filter([](int i) { return i % 2 == 0; }) |
+               count_by([](int i) { return i % 7; });
+  ASSERT_EQ(table.size(), 7u);
+  size_t total = 0;
+  for (auto count : table | values) {
+    total += count;
+  }
+  ASSERT_EQ(total, 500u);
+  ASSERT_EQ(*table.find(0), 72u);
+}
+
+TEST(RangesTestSuit, GroupByMergeTest) {
+  vector<int> v;
+  for (int i = 0; i < 10000; ++i) {
+    v.push_back(i);
+  }
+  auto key = [](int i) { return i % 100; };
+  auto sum = [](long long acc, long long x) { return acc + x; };
+  FlatMap<int, long long> left;
+  FlatMap<int, long long> right;
+  thread t1([&] {
+    auto part = v | take(5000);
+    group_by(part, key).aggregate_into(left, 0ll, sum);
+  });
+  thread t2([&] {
+    auto part = v | drop(5000);
+    group_by(part, key).aggregate_into(right, 0ll, sum);
+  });
+  t1.join();
+  t2.join();
+  left.merge(right, sum);
+  auto expected = v | group_by(key) | aggregate(0ll, sum);
+  ASSERT_EQ(left.size(), expected.size());
+  for (auto [k, value] : expected) {
+    ASSERT_EQ(*left.find(k), value);
+  }
+  left.clear();
+  ASSERT_TRUE(left.empty());
+  ASSERT_EQ(left.find(1), nullptr);
+}
+
+TEST(RangesTestSuit, MutableFilterTest) {
+  vector<int> v = {1, 8, 9, 10, 11, 2, 3, 4};
+  for (auto& value : v | filter([](int i) { return i % 2 == 0; })) {
+    value *= 2;
+  }
+  vector<int> ans = {1, 16, 9, 20, 11, 4, 3, 8};
+  ASSERT_EQ(v, ans);
+}
+
+TEST(RangesTestSuit, MutableValuesTest) {
+  map<int, std::string> m = {
+      {35, "i"}, {434, "like"}, {3, "c++"}, {82323, "hello"}, {22, "world"}};
+  for (auto& value : m | drop(1) | take(3) | values) {
+    value.clear();
+  }
+  vector<std::string> ans = {"c++", "", "", "", "hello"};
+  int i = 0;
+  for (auto value : m | values) {
+    ASSERT_EQ(value, ans[i]);
+    ++i;
+  }
+}
+
+TEST(RangesTestSuit, MutableAlgorithmTest) {
+  vector<int> v = {1, 8, 9, 10, 11, 2, 3, 4};
+  auto tail = v | drop(5);
+  std::fill(tail.begin(), tail.end(), 0);
+  auto reversed = v | reverse | take(4);
+  std::replace(reversed.begin(), reversed.end(), 0, 7);
+  vector<int> ans = {1, 8, 9, 10, 11, 7, 7, 7};
+  ASSERT_EQ(v, ans);
+}
+
+TEST(RangesTestSuit, IteratorCategoryTest) {
+  vector<int> v = {1, 2, 3, 4, 5, 6, 7, 8};
+  auto even = v | filter([](int i) { return i % 2 == 0; });
+  ASSERT_EQ(std::distance(even.begin(), even.end()), 4);
+  auto head = v | take(3);
+  std::reverse(head.begin(), head.end());
+  vector<int> ans = {3, 2, 1, 4, 5, 6, 7, 8};
+  ASSERT_EQ(v, ans);
+  auto descending = v | drop(3) | reverse;
+  auto it = std::lower_bound(descending.begin(), descending.end(), 6,
+                             greater<>());
+  ASSERT_EQ(*it, 6);
+  using category =
+      iterator_traits<decltype(descending.begin())>::iterator_category;
+  static_assert(std::is_same_v<category, bidirectional_iterator_tag>);
+}
+
+TEST(RangesTestSuit, AnyViewTest) {
+  vector<int> v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(i);
+  }
+  auto odd = v | filter([](int i) { return i % 2 == 1; });
+  auto squares = odd | transform([](int i) { return i * i; });
+  vector<any_view<int>> views = {v, odd, squares | drop(45), any_view<int>()};
+  int i = 0;
+  for (auto val : views[0]) {
+    ASSERT_EQ(val, i);
+    ++i;
+  }
+  ASSERT_EQ(i, 100);
+  i = 0;
+  for (auto val : views[1]) {
+    ASSERT_EQ(val, 2 * i + 1);
+    ++i;
+  }
+  ASSERT_EQ(i, 50);
+  vector<int> ans = {91 * 91, 93 * 93, 95 * 95, 97 * 97, 99 * 99};
+  i = 0;
+  for (auto val : views[2]) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 5);
+  ASSERT_EQ(views[3].begin(), views[3].end());
+}
+
+TEST(RangesTestSuit, AnyViewPipelineTest) {
+  map<int, std::string> m = {
+      {35, "i"}, {434, "like"}, {3, "c++"}, {82323, "hello"}, {22, "world"}};
+  any_view<std::string> view = m | values;
+  any_view<std::string> copy = view;
+  vector<string> ans = {"c++", "i"};
+  int i = 0;
+  for (auto val : copy | filter([](const string& s) { return s.size() <= 3; }) |
+                      take(2)) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 2);
+  auto it = view.begin();
+  auto saved = it;
+  ++it;
+  ASSERT_EQ(*saved, "c++");
+  ASSERT_EQ(*it, "world");
+}
+
+any_view<int> odd_squares(const vector<int>& v) {
+  return v | filter([](int i) { return i % 2 == 1; }) |
+         transform([](int i) { return i * i; });
+}
+
+any_view<int> owned_range(int n) {
+  vector<int> v;
+  for (int i = 0; i < n; ++i) {
+    v.push_back(i);
+  }
+  return std::move(v) | drop(1) | reverse;
+}
+
+TEST(RangesTestSuit, AnyViewReturnTest) {
+  vector<int> v = {1, 2, 3, 4, 5};
+  any_view<int> squares = odd_squares(v);
+  vector<int> ans = {1, 9, 25};
+  int i = 0;
+  for (auto val : squares) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 3);
+  ans = {4, 3, 2, 1};
+  i = 0;
+  for (auto val : owned_range(5)) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 4);
+}
+
+TEST(RangesTestSuit, AnyViewLoopTest) {
+  vector<int> v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(i);
+  }
+  vector<std::function<bool(int)>> fs = {[](int i) { return i % 2 == 0; },
+                                         [](int i) { return i % 3 == 0; },
+                                         [](int i) { return i > 50; }};
+  any_view<int> cur = v;
+  for (auto& f : fs) {
+    cur = cur | filter(f);
+  }
+  vector<int> ans = {54, 60, 66, 72, 78, 84, 90, 96};
+  int i = 0;
+  for (auto val : cur) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 8);
+}
+
+TEST(RangesTestSuit, ConstexprTest) {
+  constexpr auto table = to_array<4>(
+      iota(0, 256) | transform([](int i) { return i * i; }) |
+      filter([](int i) { return i % 3 == 0; }) | drop(1) | take(4));
+  static_assert(table[0] == 9);
+  static_assert(table[1] == 36);
+  static_assert(table[2] == 81);
+  static_assert(table[3] == 144);
+
+  static constexpr array<int, 6> a = {5, 3, 1, 6, 4, 2};
+  constexpr auto reversed = to_array<3>(a | reverse | take(3));
+  static_assert(reversed == array<int, 3>{2, 4, 6});
+  constexpr auto smallest = to_array<3>(a | sorted() | take(3));
+  static_assert(smallest == array<int, 3>{1, 2, 3});
+  constexpr auto largest = to_array<2>(a | top_k(2, greater<>()));
+  static_assert(largest == array<int, 2>{6, 5});
+  constexpr auto large = to_array<3>(a | filter([](int i) { return i > 3; }));
+  static_assert(large == array<int, 3>{5, 6, 4});
+
+  static constexpr array<pair<int, char>, 3> p = {
+      pair{1, 'a'}, pair{2, 'b'}, pair{3, 'c'}};
+  static_assert(to_array<3>(p | keys) == array<int, 3>{1, 2, 3});
+  static_assert(to_array<2>(p | values | drop(1)) == array<char, 2>{'b', 'c'});
+
+  auto runtime = to_array<3>(a | reverse | take(3));
+  ASSERT_EQ(runtime, reversed);
+  ASSERT_THROW(to_array<3>(a | reverse), length_error);
+  ASSERT_THROW(to_array<8>(a | reverse), length_error);
+}
+
+TEST(RangesTestSuit, TakeWhileTest) {
+  vector<int> v = {1, 3, 5, 8, 9, 11, 2};
+  int calls = 0;
+  auto odd = [&calls](int i) {
+    ++calls;
+    return i % 2 == 1;
+  };
+  vector<int> ans = {1, 3, 5};
+  int i = 0;
+  for (auto val : take_while(v, odd)) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 3);
+  ASSERT_EQ(calls, 4);
+
+  map<int, string> m = {{1, "a"}, {4, "b"}, {7, "c"}, {9, "d"}, {12, "e"}};
+  auto k = m | keys;
+  ans = {1, 4, 7};
+  i = 0;
+  for (auto key : k | take_while([](int key) { return key < 8; }, monotone)) {
+    ASSERT_EQ(key, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 3);
+}
+
+TEST(RangesTestSuit, MonotoneTakeWhileTest) {
+  vector<int> v;
+  for (int i = 0; i < 1000; ++i) {
+    v.push_back(i * 2);
+  }
+  int calls = 0;
+  auto below = take_while(
+      v,
+      [&calls](int i) {
+        ++calls;
+        return i < 100;
+      },
+      monotone);
+  ASSERT_EQ(below.end() - below.begin(), 50);
+  ASSERT_LE(calls, 11);
+  for (auto& val : below) {
+    val = -1;
+  }
+  ASSERT_EQ(v[49], -1);
+  ASSERT_EQ(v[50], 100);
+}
+
+TEST(RangesTestSuit, DropWhileTest) {
+  forward_list<int> l = {1, 3, 5, 8, 9, 11, 2};
+  int calls = 0;
+  auto tail = l | drop_while([&calls](int i) {
+                ++calls;
+                return i % 2 == 1;
+              });
+  vector<int> ans = {8, 9, 11, 2};
+  for (int pass = 0; pass < 2; ++pass) {
+    int i = 0;
+    for (auto val : tail) {
+      ASSERT_EQ(val, ans[i]);
+      ++i;
+    }
+    ASSERT_EQ(i, 4);
+  }
+  ASSERT_EQ(calls, 4);
+}
+
+TEST(RangesTestSuit, UniqueTest) {
+  vector<int> v = {1, 1, 2, 2, 2, 3, 1, 1, 4};
+  vector<int> ans = {1, 2, 3, 1, 4};
+  int i = 0;
+  for (auto val : v | unique) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 5);
+  vector<int> empty;
+  ASSERT_EQ(unique(empty).begin(), unique(empty).end());
+}
+
+TEST(RangesTestSuit, AdjacentTest) {
+  vector<int> v = {1, 4, 9, 16, 25};
+  vector<int> ans = {3, 5, 7, 9};
+  int i = 0;
+  for (auto [a, b] : v | pairwise) {
+    ASSERT_EQ(b - a, ans[i]);
+    ++i;
+  }
+  ASSERT_EQ(i, 4);
+
+  auto triples = adjacent<3>(v);
+  static_assert(std::random_access_iterator<decltype(triples.begin())>);
+  using window = iterator_traits<decltype(triples.begin())>;
+  static_assert(is_same_v<window::value_type, tuple<int, int, int>>);
+  static_assert(is_same_v<window::iterator_category, input_iterator_tag>);
+  ASSERT_EQ(triples.end() - triples.begin(), 3);
+  ASSERT_EQ(2 + triples.begin(), triples.end() - 1);
+  auto [x, y, z] = triples.begin()[2];
+  ASSERT_EQ(x + y + z, 50);
+  get<1>(*triples.begin()) = 0;
+  ASSERT_EQ(v[1], 0);
+
+  list<int> l = {1, 2, 3};
+  static_assert(std::forward_iterator<decltype(adjacent<2>(l).begin())>);
+  i = 0;
+  for ([[maybe_unused]] auto [a, b, c, d] : l | adjacent<4>()) {
+    ++i;
+  }
+  ASSERT_EQ(i, 0);
+  for (auto [a, b, c] : l | adjacent<3>()) {
+    ASSERT_EQ(a + b + c, 6);
+    ++i;
+  }
+  ASSERT_EQ(i, 1);
+}
+
+TEST(RangesTestSuit, CacheAllTest) {
+  map<int, int> m;
+  for (int i = 0; i < 100; ++i) {
+    m[i] = i * 3;
+  }
+  int calls = 0;
+  auto vals = m | values;
+  auto even = vals | filter([&calls](int i) {
+    ++calls;
+    return i % 2 == 0;
+  });
+  auto halves = even | transform([](int i) { return i / 2; });
+  auto reversed = halves | reverse;
+  Arena arena;
+  auto cached = reversed | cache_all(arena);
+  ASSERT_EQ(calls, 0);
+  ASSERT_EQ(cached.size(), 50u);
+  int after_first = calls;
+  for (int pass = 0; pass < 3; ++pass) {
+    int i = 0;
+    for (auto val : cached) {
+      ASSERT_EQ(val, (98 - 2 * i) * 3 / 2);
+      ++i;
+    }
+    ASSERT_EQ(i, 50);
+  }
+  ASSERT_EQ(calls, after_first);
+  ASSERT_EQ(cached[49], 0);
+  ASSERT_EQ(cached.end() - cached.begin(), 50);
+
+  vector<int> ans = {147, 144};
+  int i = 0;
+  for (auto val : cached | take(2)) {
+    ASSERT_EQ(val, ans[i]);
+    ++i;
+  }
+}
+
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t allocated = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocated += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+TEST(RangesTestSuit, CacheAllComposeTest) {
+  list<int> l;
+  for (int i = 0; i < 100; ++i) {
+    l.push_back(i);
+  }
+  int calls = 0;
+  CountingResource resource;
+  auto cached = l | filter([&calls](int i) {
+                  ++calls;
+                  return i % 2 == 0;
+                }) |
+                cache_all(resource);
+  int after_first = 0;
+  size_t allocated = 0;
+  for (int pass = 0; pass < 3; ++pass) {
+    int i = 0;
+    for (auto val : cached | take(5)) {
+      ASSERT_EQ(val, 2 * i);
+      ++i;
+    }
+    ASSERT_EQ(i, 5);
+    if (pass == 0) {
+      after_first = calls;
+      allocated = resource.allocated;
+    }
+  }
+  ASSERT_LE(calls, 101);
+  ASSERT_GT(allocated, 0u);
+  ASSERT_EQ(cached.size(), 50u);
+  ASSERT_EQ(*(cached | reverse).begin(), 98);
+  ASSERT_EQ(calls, after_first);
+  ASSERT_EQ(resource.allocated, allocated);
+}
+
+TEST(RangesTestSuit, CacheAllAllocationTest) {
+  list<int> l;
+  for (int i = 0; i < 1000; ++i) {
+    l.push_back(i);
+  }
+  CountingResource resource;
+  auto cached = l | filter([](int i) { return i % 3 == 0; }) |
+                cache_all(resource);
+  ASSERT_EQ(cached.size(), 334u);
+  ASSERT_EQ(cached[333], 999);
+  // Growth by doubling: at most twice the final capacity, which itself is
+  // under twice the size.
+  ASSERT_LT(resource.allocated, 4 * 334 * sizeof(int));
+}
+
+TEST(RangesTestSuit, ArenaTest) {
+  Arena arena(256);
+  vector<string> v = {"a", "bb", "ccc"};
+  const void* first = nullptr;
+  for (int round = 0; round < 3; ++round) {
+    {
+      auto cached = cache_all(v, arena);
+      ASSERT_EQ(cached.size(), 3u);
+      ASSERT_EQ(cached[2], "ccc");
+      if (round == 0) {
+        first = cached.begin();
+      }
+      ASSERT_EQ(static_cast<const void*>(cached.begin()), first);
+    }
+    arena.reset();
+  }
+  vector<int> big(1000, 7);
+  auto cached = big | cache_all(arena);
+  ASSERT_EQ(cached.size(), 1000u);
+  ASSERT_EQ(cached[999], 7);
+  auto head = big | take(3);
+  auto fallback = head | cache_all();
+  ASSERT_EQ(fallback.size(), 3u);
+}